@@ -3,12 +3,26 @@
 #include <string.h>
 #include <time.h>
 #include <ctype.h>
+#include <stddef.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#endif
 
 #define MAX_TASKS 100
 #define MAX_TITLE 100
 #define MAX_DESC 500
 #define MAX_CATEGORY 50
+#define MAX_TOMBSTONES 100
+#define MAX_FILENAME 256
 #define FILENAME "tasks.dat"
+#define TMPFILE "tasks.dat.tmp"
+#define LOCKFILE "tasks.dat.lock"
+#define STORE_MAGIC "TSK2"
+#define STORE_VERSION 4
+#define CHANGES_MAGIC "TCHG"
+#define CHANGES_VERSION 1
 
 typedef enum {
     PRIORITY_LOW = 1,
@@ -34,18 +48,118 @@ typedef struct {
     time_t created;
     time_t deadline;
     int completed;
+    unsigned long seq;      // change sequence of the last write to this task
 } Task;
 
+typedef enum {
+    BULK_COMPLETE = 1,
+    BULK_CANCEL,
+    BULK_REPRIORITIZE,
+    BULK_RECATEGORIZE,
+    BULK_DELETE
+} BulkAction;
+
+// Selection for bulk operations; 0 / empty fields match anything
+typedef struct {
+    Status status;
+    Priority priority;
+    char category[MAX_CATEGORY];
+} TaskFilter;
+
+// Records a deletion so it can be replayed by the change feed
+typedef struct {
+    int id;
+    unsigned long seq;
+} Tombstone;
+
+// Links a task imported from another store to its id in this one, so
+// imported tasks never collide with tasks created here
+typedef struct {
+    int sourceId;
+    int localId;
+} IdMapping;
+
 typedef struct {
     Task tasks[MAX_TASKS];
     int count;
     int nextId;
+    unsigned long seq;      // change sequence of the store we last synced with
+    int lockFd;
+    Tombstone tombstones[MAX_TOMBSTONES];
+    int tombCount;
+    unsigned long horizon;  // deletions at or before this seq are forgotten
+    unsigned long sourceSeq; // last source seq merged in by importChanges
+    IdMapping idMap[MAX_TASKS];
+    int mapCount;
+    int orderChanged;       // sorted locally since the last commit
 } TaskManager;
 
+// On-disk layout: StoreHeader, RecordKey[count], Task[count], then the
+// tombstone tail (int tombCount, unsigned long horizon, Tombstone[]) and,
+// from version 4, the import id map (int mapCount, IdMapping[]).
+// The key table lets other instances find changed records without
+// reading every task.
+typedef struct {
+    char magic[4];
+    int version;
+    unsigned long seq;
+    int count;
+    int nextId;
+    unsigned long sourceSeq;    // added in version 3
+} StoreHeader;
+
+typedef struct {
+    int id;
+    unsigned long seq;
+} RecordKey;
+
+typedef enum {
+    CHANGE_UPSERT = 1,
+    CHANGE_DELETE
+} ChangeOp;
+
+// Change feed file: ChangeHeader followed by count ChangeRecords.
+// A reset feed is a full snapshot and replaces the target's contents.
+typedef struct {
+    char magic[4];
+    int version;
+    unsigned long fromSeq;
+    unsigned long toSeq;
+    int count;
+    int reset;
+} ChangeHeader;
+
+typedef struct {
+    int op;
+    Task task;              // only task.id is meaningful for CHANGE_DELETE
+} ChangeRecord;
+
 // Function declarations
 void initTaskManager(TaskManager *tm);
 void loadTasks(TaskManager *tm);
-void saveTasks(TaskManager *tm);
+int saveTasks(TaskManager *tm);
+int readStoreHeader(FILE *fp, StoreHeader *h);
+int syncTasks(TaskManager *tm, int force);
+int writeStore(TaskManager *tm);
+int lockStore(TaskManager *tm);
+void unlockStore(TaskManager *tm);
+int beginUpdate(TaskManager *tm);
+int commitUpdate(TaskManager *tm);
+void abortUpdate(TaskManager *tm);
+void touchTask(TaskManager *tm, Task *t);
+int findTaskIndex(TaskManager *tm, int id);
+void addTombstone(TaskManager *tm, int id);
+int findMapping(TaskManager *tm, int sourceId);
+int addMapping(TaskManager *tm, int sourceId, int localId);
+void removeMapping(TaskManager *tm, int m);
+int removeImported(TaskManager *tm, int localId);
+int writeChanges(TaskManager *tm, unsigned long since, FILE *fp);
+int applyChanges(TaskManager *tm, FILE *fp);
+void exportChanges(TaskManager *tm);
+void importChanges(TaskManager *tm);
+int taskMatches(TaskFilter *f, Task *t);
+int applyBulk(TaskManager *tm, TaskFilter *f, BulkAction action, Priority priority, const char *category);
+void bulkUpdate(TaskManager *tm);
 void displayMenu();
 void addTask(TaskManager *tm);
 void viewAllTasks(TaskManager *tm);
@@ -66,9 +180,13 @@ char* getStatusString(Status s);
 void displayTask(Task *t);
 void displayTaskSummary(Task *t, int index);
 int getIntInput(const char *prompt, int min, int max);
+unsigned long getSeqInput(const char *prompt, unsigned long max);
 void getStringInput(const char *prompt, char *buffer, int maxLen);
 time_t getDateInput(const char *prompt);
 
+// State captured by beginUpdate, restored if the mutation is abandoned
+static TaskManager undoState;
+
 int main() {
     TaskManager tm;
     int choice;
@@ -84,7 +202,10 @@ int main() {
     while (1) {
         clearScreen();
         displayMenu();
-        choice = getIntInput("Enter your choice", 0, 13);
+        choice = getIntInput("Enter your choice", 0, 16);
+        
+        // Cheap header poll; reloads only records other instances changed
+        syncTasks(&tm, 0);
         
         switch (choice) {
             case 1:
@@ -124,13 +245,24 @@ int main() {
                 viewStatistics(&tm);
                 break;
             case 13:
-                saveTasks(&tm);
-                printf("\n✓ Tasks saved successfully!\n");
+                if (saveTasks(&tm)) {
+                    printf("\n✓ Tasks saved successfully!\n");
+                }
                 pauseScreen();
                 break;
+            case 14:
+                exportChanges(&tm);
+                break;
+            case 15:
+                importChanges(&tm);
+                break;
+            case 16:
+                bulkUpdate(&tm);
+                break;
             case 0:
-                saveTasks(&tm);
-                printf("\n✓ Tasks saved. Goodbye!\n");
+                if (saveTasks(&tm)) {
+                    printf("\n✓ Tasks saved. Goodbye!\n");
+                }
                 return 0;
             default:
                 printf("\n✗ Invalid choice!\n");
@@ -144,6 +276,13 @@ int main() {
 void initTaskManager(TaskManager *tm) {
     tm->count = 0;
     tm->nextId = 1;
+    tm->seq = 0;
+    tm->lockFd = -1;
+    tm->tombCount = 0;
+    tm->horizon = 0;
+    tm->sourceSeq = 0;
+    tm->mapCount = 0;
+    tm->orderChanged = 0;
 }
 
 void loadTasks(TaskManager *tm) {
@@ -153,26 +292,508 @@ void loadTasks(TaskManager *tm) {
         return;
     }
     
-    fread(&tm->count, sizeof(int), 1, fp);
-    fread(&tm->nextId, sizeof(int), 1, fp);
-    fread(tm->tasks, sizeof(Task), tm->count, fp);
+    StoreHeader h;
+    int valid = readStoreHeader(fp, &h);
+    if (valid < 0) {
+        fclose(fp);
+        printf("✗ %s is damaged; changes cannot be saved until it is repaired.\n", FILENAME);
+        return;
+    }
+    
+    if (valid == 0) {
+        // Pre-v2 file: count, nextId, then tasks without a seq field
+        rewind(fp);
+        fread(&tm->count, sizeof(int), 1, fp);
+        fread(&tm->nextId, sizeof(int), 1, fp);
+        if (tm->count < 0 || tm->count > MAX_TASKS) tm->count = 0;
+        
+        for (int i = 0; i < tm->count; i++) {
+            memset(&tm->tasks[i], 0, sizeof(Task));
+            fread(&tm->tasks[i], offsetof(Task, seq), 1, fp);
+        }
+        
+        fclose(fp);
+        printf("✓ Loaded %d tasks from file.\n", tm->count);
+        return;
+    }
     
     fclose(fp);
+    if (syncTasks(tm, 1) < 0) {
+        printf("✗ %s is damaged; changes cannot be saved until it is repaired.\n", FILENAME);
+        return;
+    }
     printf("✓ Loaded %d tasks from file.\n", tm->count);
 }
 
-void saveTasks(TaskManager *tm) {
-    FILE *fp = fopen(FILENAME, "wb");
-    if (fp == NULL) {
-        printf("✗ Error saving tasks!\n");
-        return;
+// Every mutation commits as it happens, so only a local sort is left to
+// write here. Returns 0 if that write failed.
+int saveTasks(TaskManager *tm) {
+    if (!tm->orderChanged) return 1;
+    if (!beginUpdate(tm)) return 0;
+    return commitUpdate(tm);
+}
+
+// Returns 1 for a valid header, 0 for a file that predates headers, and
+// -1 for a file that has our magic but cannot be trusted.
+int readStoreHeader(FILE *fp, StoreHeader *h) {
+    if (fread(h->magic, sizeof(h->magic), 1, fp) != 1) return 0;
+    if (memcmp(h->magic, STORE_MAGIC, sizeof(h->magic)) != 0) return 0;
+    
+    size_t rest = offsetof(StoreHeader, sourceSeq) - sizeof(h->magic);
+    if (fread((char *)h + sizeof(h->magic), rest, 1, fp) != 1) return -1;
+    if (h->count < 0 || h->count > MAX_TASKS) return -1;
+    
+    // Version 2 headers end before sourceSeq
+    h->sourceSeq = 0;
+    if (h->version == 2) return 1;
+    if (h->version < 3 || h->version > STORE_VERSION) return -1;
+    return fread(&h->sourceSeq, sizeof(unsigned long), 1, fp) == 1 ? 1 : -1;
+}
+
+// Brings the in-memory tasks up to date with the file. Only the header is
+// read when nothing changed; otherwise the key table is compared against
+// memory and just the added or modified records are fetched. Local order
+// is kept, new tasks are appended, and tasks deleted elsewhere are dropped.
+// Returns the number of records read from disk, or -1 if the file is
+// damaged, in which case memory is left untouched.
+int syncTasks(TaskManager *tm, int force) {
+    FILE *fp = fopen(FILENAME, "rb");
+    if (fp == NULL) return 0;
+    
+    StoreHeader h;
+    int valid = readStoreHeader(fp, &h);
+    if (valid <= 0 || (!force && h.seq == tm->seq)) {
+        fclose(fp);
+        return valid < 0 ? -1 : 0;
     }
     
-    fwrite(&tm->count, sizeof(int), 1, fp);
-    fwrite(&tm->nextId, sizeof(int), 1, fp);
-    fwrite(tm->tasks, sizeof(Task), tm->count, fp);
+    RecordKey keys[MAX_TASKS];
+    if (fread(keys, sizeof(RecordKey), h.count, fp) != (size_t)h.count) {
+        fclose(fp);
+        return -1;
+    }
+    
+    long recordBase = ftell(fp);
+    static Task merged[MAX_TASKS];
+    int used[MAX_TASKS] = {0};
+    int n = 0, fetched = 0;
+    
+    // Keep local tasks that still exist, refetching those changed elsewhere
+    for (int i = 0; i < tm->count; i++) {
+        int j = i;
+        if (j >= h.count || keys[j].id != tm->tasks[i].id) {
+            for (j = 0; j < h.count && keys[j].id != tm->tasks[i].id; j++);
+            if (j >= h.count) continue;
+        }
+        
+        used[j] = 1;
+        if (keys[j].seq == tm->tasks[i].seq) {
+            merged[n++] = tm->tasks[i];
+            continue;
+        }
+        
+        // A short read means the file is damaged; dropping the record
+        // here would delete it for everyone on the next commit
+        fseek(fp, recordBase + j * (long)sizeof(Task), SEEK_SET);
+        if (fread(&merged[n], sizeof(Task), 1, fp) != 1) {
+            fclose(fp);
+            return -1;
+        }
+        n++;
+        fetched++;
+    }
+    
+    // Append tasks added by other instances
+    for (int j = 0; j < h.count; j++) {
+        if (used[j]) continue;
+        
+        fseek(fp, recordBase + j * (long)sizeof(Task), SEEK_SET);
+        if (fread(&merged[n], sizeof(Task), 1, fp) != 1) {
+            fclose(fp);
+            return -1;
+        }
+        n++;
+        fetched++;
+    }
+    
+    // Tombstone tail; version 2 stores written before it existed have no
+    // deletion history, so everything up to their seq counts as forgotten
+    static Tombstone tombs[MAX_TOMBSTONES];
+    int tombCount;
+    unsigned long horizon;
+    fseek(fp, recordBase + h.count * (long)sizeof(Task), SEEK_SET);
+    if (fread(&tombCount, sizeof(int), 1, fp) != 1 ||
+        tombCount < 0 || tombCount > MAX_TOMBSTONES ||
+        fread(&horizon, sizeof(unsigned long), 1, fp) != 1 ||
+        fread(tombs, sizeof(Tombstone), tombCount, fp) != (size_t)tombCount) {
+        if (h.version != 2) {
+            fclose(fp);
+            return -1;
+        }
+        tombCount = 0;
+        horizon = h.seq;
+    }
+    
+    // Import id map. Older stores imported tasks under their source ids,
+    // so a store that has imported anything gets an identity map
+    static IdMapping idMap[MAX_TASKS];
+    int mapCount = 0;
+    if (h.version >= 4) {
+        if (fread(&mapCount, sizeof(int), 1, fp) != 1 ||
+            mapCount < 0 || mapCount > MAX_TASKS ||
+            fread(idMap, sizeof(IdMapping), mapCount, fp) != (size_t)mapCount) {
+            fclose(fp);
+            return -1;
+        }
+    } else if (h.sourceSeq > 0) {
+        for (int j = 0; j < h.count; j++) {
+            idMap[mapCount].sourceId = keys[j].id;
+            idMap[mapCount].localId = keys[j].id;
+            mapCount++;
+        }
+    }
     
     fclose(fp);
+    
+    memcpy(tm->tombstones, tombs, tombCount * sizeof(Tombstone));
+    tm->tombCount = tombCount;
+    tm->horizon = horizon;
+    memcpy(tm->idMap, idMap, mapCount * sizeof(IdMapping));
+    tm->mapCount = mapCount;
+    memcpy(tm->tasks, merged, n * sizeof(Task));
+    tm->count = n;
+    tm->nextId = h.nextId;
+    tm->seq = h.seq;
+    tm->sourceSeq = h.sourceSeq;
+    return fetched;
+}
+
+// Writes the whole store to a temporary file and renames it over the data
+// file, so readers always see either the old or the new version.
+int writeStore(TaskManager *tm) {
+    FILE *fp = fopen(TMPFILE, "wb");
+    if (fp == NULL) return 0;
+    
+    StoreHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, STORE_MAGIC, sizeof(h.magic));
+    h.version = STORE_VERSION;
+    h.seq = tm->seq;
+    h.count = tm->count;
+    h.nextId = tm->nextId;
+    h.sourceSeq = tm->sourceSeq;
+    
+    int ok = fwrite(&h, sizeof(h), 1, fp) == 1;
+    for (int i = 0; i < tm->count && ok; i++) {
+        RecordKey k;
+        memset(&k, 0, sizeof(k));
+        k.id = tm->tasks[i].id;
+        k.seq = tm->tasks[i].seq;
+        ok = fwrite(&k, sizeof(k), 1, fp) == 1;
+    }
+    if (ok) ok = fwrite(tm->tasks, sizeof(Task), tm->count, fp) == (size_t)tm->count;
+    if (ok) ok = fwrite(&tm->tombCount, sizeof(int), 1, fp) == 1;
+    if (ok) ok = fwrite(&tm->horizon, sizeof(unsigned long), 1, fp) == 1;
+    if (ok) ok = fwrite(tm->tombstones, sizeof(Tombstone), tm->tombCount, fp) == (size_t)tm->tombCount;
+    if (ok) ok = fwrite(&tm->mapCount, sizeof(int), 1, fp) == 1;
+    if (ok) ok = fwrite(tm->idMap, sizeof(IdMapping), tm->mapCount, fp) == (size_t)tm->mapCount;
+    
+    // Make the data durable before the rename publishes it
+    if (ok) ok = fflush(fp) == 0;
+#ifndef _WIN32
+    if (ok) ok = fsync(fileno(fp)) == 0;
+#endif
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok) {
+        remove(TMPFILE);
+        return 0;
+    }
+    
+#ifdef _WIN32
+    remove(FILENAME);
+#endif
+    return rename(TMPFILE, FILENAME) == 0;
+}
+
+// Advisory lock serialising writers across instances. Readers need no
+// lock because writeStore replaces the file atomically.
+int lockStore(TaskManager *tm) {
+#ifndef _WIN32
+    tm->lockFd = open(LOCKFILE, O_RDWR | O_CREAT, 0644);
+    if (tm->lockFd < 0) return 0;
+    
+    if (flock(tm->lockFd, LOCK_EX) != 0) {
+        close(tm->lockFd);
+        tm->lockFd = -1;
+        return 0;
+    }
+#endif
+    return 1;
+}
+
+void unlockStore(TaskManager *tm) {
+#ifndef _WIN32
+    if (tm->lockFd >= 0) {
+        flock(tm->lockFd, LOCK_UN);
+        close(tm->lockFd);
+        tm->lockFd = -1;
+    }
+#endif
+}
+
+// Starts a mutation: takes the lock and reloads whatever other instances
+// changed, so edits are applied on top of the latest data.
+int beginUpdate(TaskManager *tm) {
+    if (!lockStore(tm)) {
+        printf("\n✗ Could not lock %s!\n", FILENAME);
+        return 0;
+    }
+    
+    // Editing on top of a failed sync would overwrite other instances' work
+    if (syncTasks(tm, 0) < 0) {
+        unlockStore(tm);
+        printf("\n✗ %s is damaged; refusing to overwrite it!\n", FILENAME);
+        return 0;
+    }
+    
+    undoState = *tm;
+    return 1;
+}
+
+// Publishes the mutation under a new change sequence and releases the lock.
+// On failure the mutation is rolled back in memory as well.
+int commitUpdate(TaskManager *tm) {
+    // Never publish a seq other instances may already hold
+    FILE *fp = fopen(FILENAME, "rb");
+    if (fp != NULL) {
+        StoreHeader h;
+        int valid = readStoreHeader(fp, &h);
+        fclose(fp);
+        
+        if (valid < 0 || (valid > 0 && h.seq > tm->seq)) {
+            printf("\n✗ %s changed unexpectedly; not saving!\n", FILENAME);
+            abortUpdate(tm);
+            return 0;
+        }
+    }
+    
+    tm->seq++;
+    if (writeStore(tm)) {
+        tm->orderChanged = 0;
+        unlockStore(tm);
+        return 1;
+    }
+    
+    printf("\n✗ Error saving tasks!\n");
+    abortUpdate(tm);
+    return 0;
+}
+
+// Discards everything done since beginUpdate and releases the lock
+void abortUpdate(TaskManager *tm) {
+    *tm = undoState;
+    unlockStore(tm);
+}
+
+void touchTask(TaskManager *tm, Task *t) {
+    t->seq = tm->seq + 1;
+}
+
+int findTaskIndex(TaskManager *tm, int id) {
+    for (int i = 0; i < tm->count; i++) {
+        if (tm->tasks[i].id == id) return i;
+    }
+    return -1;
+}
+
+// Must be called inside beginUpdate/commitUpdate. When the history is full
+// the oldest deletion is forgotten and the horizon advances past it.
+void addTombstone(TaskManager *tm, int id) {
+    if (tm->tombCount >= MAX_TOMBSTONES) {
+        tm->horizon = tm->tombstones[0].seq;
+        memmove(tm->tombstones, tm->tombstones + 1,
+                (MAX_TOMBSTONES - 1) * sizeof(Tombstone));
+        tm->tombCount--;
+    }
+    
+    tm->tombstones[tm->tombCount].id = id;
+    tm->tombstones[tm->tombCount].seq = tm->seq + 1;
+    tm->tombCount++;
+}
+
+int findMapping(TaskManager *tm, int sourceId) {
+    for (int m = 0; m < tm->mapCount; m++) {
+        if (tm->idMap[m].sourceId == sourceId) return m;
+    }
+    return -1;
+}
+
+// Returns 0 if the map is full. Links to imported tasks that were since
+// deleted here are dropped to make room.
+int addMapping(TaskManager *tm, int sourceId, int localId) {
+    if (tm->mapCount >= MAX_TASKS) {
+        int n = 0;
+        for (int m = 0; m < tm->mapCount; m++) {
+            if (findTaskIndex(tm, tm->idMap[m].localId) >= 0) {
+                tm->idMap[n++] = tm->idMap[m];
+            }
+        }
+        tm->mapCount = n;
+        if (n >= MAX_TASKS) return 0;
+    }
+    
+    tm->idMap[tm->mapCount].sourceId = sourceId;
+    tm->idMap[tm->mapCount].localId = localId;
+    tm->mapCount++;
+    return 1;
+}
+
+void removeMapping(TaskManager *tm, int m) {
+    tm->idMap[m] = tm->idMap[--tm->mapCount];
+}
+
+// Deletes an imported task if it still exists here. Must be called
+// inside beginUpdate/commitUpdate. Returns 1 if a task was removed.
+int removeImported(TaskManager *tm, int localId) {
+    int i = findTaskIndex(tm, localId);
+    if (i < 0) return 0;
+    
+    addTombstone(tm, localId);
+    for (int j = i; j < tm->count - 1; j++) {
+        tm->tasks[j] = tm->tasks[j + 1];
+    }
+    tm->count--;
+    return 1;
+}
+
+// Writes every change after sequence `since` as a change feed. If deletions
+// from that range are no longer known (or since is 0) a full snapshot is
+// written instead. Returns the number of records written, or -1 on error.
+int writeChanges(TaskManager *tm, unsigned long since, FILE *fp) {
+    ChangeHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, CHANGES_MAGIC, sizeof(h.magic));
+    h.version = CHANGES_VERSION;
+    h.fromSeq = since;
+    h.toSeq = tm->seq;
+    h.reset = since == 0 || since < tm->horizon;
+    
+    if (!h.reset) {
+        for (int i = 0; i < tm->tombCount; i++) {
+            if (tm->tombstones[i].seq > since) h.count++;
+        }
+    }
+    for (int i = 0; i < tm->count; i++) {
+        if (h.reset || tm->tasks[i].seq > since) h.count++;
+    }
+    
+    if (fwrite(&h, sizeof(h), 1, fp) != 1) return -1;
+    
+    ChangeRecord r;
+    if (!h.reset) {
+        for (int i = 0; i < tm->tombCount; i++) {
+            if (tm->tombstones[i].seq <= since) continue;
+            
+            memset(&r, 0, sizeof(r));
+            r.op = CHANGE_DELETE;
+            r.task.id = tm->tombstones[i].id;
+            r.task.seq = tm->tombstones[i].seq;
+            if (fwrite(&r, sizeof(r), 1, fp) != 1) return -1;
+        }
+    }
+    for (int i = 0; i < tm->count; i++) {
+        if (!h.reset && tm->tasks[i].seq <= since) continue;
+        
+        memset(&r, 0, sizeof(r));
+        r.op = CHANGE_UPSERT;
+        r.task = tm->tasks[i];
+        if (fwrite(&r, sizeof(r), 1, fp) != 1) return -1;
+    }
+    
+    return h.count;
+}
+
+// Merges a change feed into the store. Must be called inside
+// beginUpdate/commitUpdate. Imported tasks get ids of their own through
+// the id map, so the feed can only change or delete tasks it created
+// here, never tasks created locally. Applied records take this store's
+// pending seq so they show up in its own change feed. Returns the number
+// of records applied, -1 if the feed is invalid, or -2 if it starts after
+// the last source seq imported here (changes in between would be lost).
+int applyChanges(TaskManager *tm, FILE *fp) {
+    ChangeHeader h;
+    if (fread(&h, sizeof(h), 1, fp) != 1) return -1;
+    if (memcmp(h.magic, CHANGES_MAGIC, sizeof(h.magic)) != 0) return -1;
+    if (h.version != CHANGES_VERSION || h.count < 0) return -1;
+    
+    if (h.reset && h.count > MAX_TASKS) return -1;
+    
+    // Older feeds, snapshots included, would roll the store back
+    if (!h.reset && h.fromSeq > tm->sourceSeq) return -2;
+    if (h.toSeq <= tm->sourceSeq) return 0;
+    
+    int applied = 0;
+    int seen[MAX_TASKS];
+    ChangeRecord r;
+    for (int n = 0; n < h.count; n++) {
+        if (fread(&r, sizeof(r), 1, fp) != 1) return -1;
+        if (h.reset) seen[n] = r.task.id;
+        
+        int m = findMapping(tm, r.task.id);
+        if (r.op == CHANGE_DELETE) {
+            if (m < 0) continue;
+            
+            int localId = tm->idMap[m].localId;
+            removeMapping(tm, m);
+            if (!removeImported(tm, localId)) continue;
+        } else if (r.op == CHANGE_UPSERT) {
+            Task incoming = r.task;
+            int i = -1;
+            if (m >= 0) {
+                incoming.id = tm->idMap[m].localId;
+                i = findTaskIndex(tm, incoming.id);
+            } else {
+                if (!addMapping(tm, r.task.id, tm->nextId)) return -1;
+                incoming.id = tm->nextId++;
+            }
+            
+            if (i >= 0) {
+                // Replayed feeds should not generate new changes here
+                incoming.seq = tm->tasks[i].seq;
+                if (memcmp(&incoming, &tm->tasks[i], sizeof(Task)) == 0) continue;
+            } else {
+                if (tm->count >= MAX_TASKS) return -1;
+                i = tm->count++;
+            }
+            
+            tm->tasks[i] = incoming;
+            touchTask(tm, &tm->tasks[i]);
+        } else {
+            return -1;
+        }
+        applied++;
+    }
+    
+    // A snapshot also removes imported tasks the source no longer has;
+    // tasks created here are not in the id map and are left alone
+    if (h.reset) {
+        for (int m = 0; m < tm->mapCount; ) {
+            int j;
+            for (j = 0; j < h.count && seen[j] != tm->idMap[m].sourceId; j++);
+            
+            if (j < h.count) {
+                m++;
+                continue;
+            }
+            
+            int localId = tm->idMap[m].localId;
+            removeMapping(tm, m);
+            if (removeImported(tm, localId)) applied++;
+        }
+    }
+    
+    tm->sourceSeq = h.toSeq;
+    return applied;
 }
 
 void displayMenu() {
@@ -192,6 +813,9 @@ void displayMenu() {
     printf("║  11. Sort Tasks                       ║\n");
     printf("║  12. View Statistics                  ║\n");
     printf("║  13. Save Tasks                       ║\n");
+    printf("║  14. Export Changes                   ║\n");
+    printf("║  15. Import Changes                   ║\n");
+    printf("║  16. Bulk Update by Filter            ║\n");
     printf("║  0.  Exit                             ║\n");
     printf("╚════════════════════════════════════════╝\n");
 }
@@ -205,30 +829,47 @@ void addTask(TaskManager *tm) {
         return;
     }
     
-    Task *t = &tm->tasks[tm->count];
-    t->id = tm->nextId++;
+    Task t;
+    memset(&t, 0, sizeof(Task));
     
     printf("\n═══ ADD NEW TASK ═══\n\n");
     
-    getStringInput("Task Title", t->title, MAX_TITLE);
-    getStringInput("Description", t->description, MAX_DESC);
-    getStringInput("Category", t->category, MAX_CATEGORY);
+    getStringInput("Task Title", t.title, MAX_TITLE);
+    getStringInput("Description", t.description, MAX_DESC);
+    getStringInput("Category", t.category, MAX_CATEGORY);
     
     printf("\nPriority Levels:\n");
     printf("  1. Low\n  2. Medium\n  3. High\n  4. Urgent\n");
-    t->priority = getIntInput("Select Priority", 1, 4);
+    t.priority = getIntInput("Select Priority", 1, 4);
     
     printf("\nStatus:\n");
     printf("  1. To Do\n  2. In Progress\n  3. Completed\n  4. Cancelled\n");
-    t->status = getIntInput("Select Status", 1, 4);
+    t.status = getIntInput("Select Status", 1, 4);
+    
+    t.created = time(NULL);
+    t.deadline = getDateInput("Deadline (YYYY-MM-DD)");
+    t.completed = 0;
+    
+    if (!beginUpdate(tm)) {
+        pauseScreen();
+        return;
+    }
     
-    t->created = time(NULL);
-    t->deadline = getDateInput("Deadline (YYYY-MM-DD)");
-    t->completed = 0;
+    // Another instance may have filled the store while we were prompting
+    if (tm->count >= MAX_TASKS) {
+        unlockStore(tm);
+        printf("\n✗ Task limit reached!\n");
+        pauseScreen();
+        return;
+    }
     
-    tm->count++;
+    t.id = tm->nextId++;
+    touchTask(tm, &t);
+    tm->tasks[tm->count++] = t;
     
-    printf("\n✓ Task #%d added successfully!\n", t->id);
+    if (commitUpdate(tm)) {
+        printf("\n✓ Task #%d added successfully!\n", t.id);
+    }
     pauseScreen();
 }
 
@@ -290,47 +931,66 @@ void updateTask(TaskManager *tm) {
     
     int id = getIntInput("Enter Task ID to update", 1, tm->nextId - 1);
     
-    for (int i = 0; i < tm->count; i++) {
-        if (tm->tasks[i].id == id) {
-            Task *t = &tm->tasks[i];
-            
-            printf("\n═══ UPDATE TASK #%d ═══\n", id);
-            printf("Leave empty to keep current value\n\n");
-            
-            char buffer[MAX_DESC];
-            
-            printf("Current Title: %s\n", t->title);
-            getStringInput("New Title", buffer, MAX_TITLE);
-            if (strlen(buffer) > 0) strcpy(t->title, buffer);
-            
-            printf("\nCurrent Description: %s\n", t->description);
-            getStringInput("New Description", buffer, MAX_DESC);
-            if (strlen(buffer) > 0) strcpy(t->description, buffer);
-            
-            printf("\nCurrent Category: %s\n", t->category);
-            getStringInput("New Category", buffer, MAX_CATEGORY);
-            if (strlen(buffer) > 0) strcpy(t->category, buffer);
-            
-            printf("\nCurrent Priority: %s\n", getPriorityString(t->priority));
-            printf("Priority: 1=Low, 2=Medium, 3=High, 4=Urgent, 0=Skip\n");
-            int p = getIntInput("New Priority", 0, 4);
-            if (p > 0) t->priority = p;
-            
-            printf("\nCurrent Status: %s\n", getStatusString(t->status));
-            printf("Status: 1=ToDo, 2=InProgress, 3=Completed, 4=Cancelled, 0=Skip\n");
-            int s = getIntInput("New Status", 0, 4);
-            if (s > 0) {
-                t->status = s;
-                if (s == STATUS_COMPLETED) t->completed = 1;
-            }
-            
-            printf("\n✓ Task updated successfully!\n");
-            pauseScreen();
-            return;
-        }
+    int i = findTaskIndex(tm, id);
+    if (i < 0) {
+        printf("\n✗ Task not found!\n");
+        pauseScreen();
+        return;
     }
     
-    printf("\n✗ Task not found!\n");
+    Task *t = &tm->tasks[i];
+    
+    printf("\n═══ UPDATE TASK #%d ═══\n", id);
+    printf("Leave empty to keep current value\n\n");
+    
+    char title[MAX_TITLE], description[MAX_DESC], category[MAX_CATEGORY];
+    
+    printf("Current Title: %s\n", t->title);
+    getStringInput("New Title", title, MAX_TITLE);
+    
+    printf("\nCurrent Description: %s\n", t->description);
+    getStringInput("New Description", description, MAX_DESC);
+    
+    printf("\nCurrent Category: %s\n", t->category);
+    getStringInput("New Category", category, MAX_CATEGORY);
+    
+    printf("\nCurrent Priority: %s\n", getPriorityString(t->priority));
+    printf("Priority: 1=Low, 2=Medium, 3=High, 4=Urgent, 0=Skip\n");
+    int p = getIntInput("New Priority", 0, 4);
+    
+    printf("\nCurrent Status: %s\n", getStatusString(t->status));
+    printf("Status: 1=ToDo, 2=InProgress, 3=Completed, 4=Cancelled, 0=Skip\n");
+    int s = getIntInput("New Status", 0, 4);
+    
+    if (!beginUpdate(tm)) {
+        pauseScreen();
+        return;
+    }
+    
+    // Re-resolve after syncing; only the fields entered here are applied,
+    // so concurrent edits to other fields survive
+    i = findTaskIndex(tm, id);
+    if (i < 0) {
+        unlockStore(tm);
+        printf("\n✗ Task was deleted by another session!\n");
+        pauseScreen();
+        return;
+    }
+    
+    t = &tm->tasks[i];
+    if (strlen(title) > 0) strcpy(t->title, title);
+    if (strlen(description) > 0) strcpy(t->description, description);
+    if (strlen(category) > 0) strcpy(t->category, category);
+    if (p > 0) t->priority = p;
+    if (s > 0) {
+        t->status = s;
+        if (s == STATUS_COMPLETED) t->completed = 1;
+    }
+    touchTask(tm, t);
+    
+    if (commitUpdate(tm)) {
+        printf("\n✓ Task updated successfully!\n");
+    }
     pauseScreen();
 }
 
@@ -355,11 +1015,28 @@ void deleteTask(TaskManager *tm) {
             getchar();
             
             if (confirm == 'y' || confirm == 'Y') {
+                if (!beginUpdate(tm)) {
+                    pauseScreen();
+                    return;
+                }
+                
+                i = findTaskIndex(tm, id);
+                if (i < 0) {
+                    unlockStore(tm);
+                    printf("\n✗ Task was deleted by another session!\n");
+                    pauseScreen();
+                    return;
+                }
+                
+                addTombstone(tm, id);
                 for (int j = i; j < tm->count - 1; j++) {
                     tm->tasks[j] = tm->tasks[j + 1];
                 }
                 tm->count--;
-                printf("\n✓ Task deleted successfully!\n");
+                
+                if (commitUpdate(tm)) {
+                    printf("\n✓ Task deleted successfully!\n");
+                }
             } else {
                 printf("\n✗ Deletion cancelled.\n");
             }
@@ -386,9 +1063,26 @@ void markTaskComplete(TaskManager *tm) {
     
     for (int i = 0; i < tm->count; i++) {
         if (tm->tasks[i].id == id) {
+            if (!beginUpdate(tm)) {
+                pauseScreen();
+                return;
+            }
+            
+            i = findTaskIndex(tm, id);
+            if (i < 0) {
+                unlockStore(tm);
+                printf("\n✗ Task was deleted by another session!\n");
+                pauseScreen();
+                return;
+            }
+            
             tm->tasks[i].status = STATUS_COMPLETED;
             tm->tasks[i].completed = 1;
-            printf("\n✓ Task marked as complete!\n");
+            touchTask(tm, &tm->tasks[i]);
+            
+            if (commitUpdate(tm)) {
+                printf("\n✓ Task marked as complete!\n");
+            }
             pauseScreen();
             return;
         }
@@ -398,6 +1092,149 @@ void markTaskComplete(TaskManager *tm) {
     pauseScreen();
 }
 
+int taskMatches(TaskFilter *f, Task *t) {
+    if (f->status && t->status != f->status) return 0;
+    if (f->priority && t->priority != f->priority) return 0;
+    if (f->category[0] && strcmp(t->category, f->category) != 0) return 0;
+    return 1;
+}
+
+// Applies one action to every matching task in a single pass, compacting
+// the array as deleted tasks are dropped. Tasks the action would not
+// change keep their seq, so they stay out of the change feed. Must be
+// called inside beginUpdate/commitUpdate. Returns the number of tasks
+// actually changed.
+int applyBulk(TaskManager *tm, TaskFilter *f, BulkAction action, Priority priority, const char *category) {
+    int affected = 0, n = 0;
+    
+    for (int i = 0; i < tm->count; i++) {
+        Task *t = &tm->tasks[i];
+        
+        if (!taskMatches(f, t)) {
+            tm->tasks[n++] = *t;
+            continue;
+        }
+        
+        int changed = 1;
+        switch (action) {
+            case BULK_COMPLETE:
+                // Tasks already Completed are left alone entirely; writing
+                // the completed flag without a new seq would never sync
+                changed = t->status != STATUS_COMPLETED;
+                if (changed) {
+                    t->status = STATUS_COMPLETED;
+                    t->completed = 1;
+                }
+                break;
+            case BULK_CANCEL:
+                changed = t->status != STATUS_CANCELLED;
+                t->status = STATUS_CANCELLED;
+                break;
+            case BULK_REPRIORITIZE:
+                changed = t->priority != priority;
+                t->priority = priority;
+                break;
+            case BULK_RECATEGORIZE:
+                changed = strcmp(t->category, category) != 0;
+                strcpy(t->category, category);
+                break;
+            case BULK_DELETE:
+                addTombstone(tm, t->id);
+                affected++;
+                continue;
+        }
+        
+        if (changed) {
+            touchTask(tm, t);
+            affected++;
+        }
+        tm->tasks[n++] = *t;
+    }
+    
+    tm->count = n;
+    return affected;
+}
+
+void bulkUpdate(TaskManager *tm) {
+    clearScreen();
+    
+    if (tm->count == 0) {
+        printf("\n✗ No tasks found!\n");
+        pauseScreen();
+        return;
+    }
+    
+    TaskFilter f;
+    memset(&f, 0, sizeof(f));
+    
+    printf("\n═══ BULK UPDATE ═══\n\n");
+    printf("Select tasks to change (0 or empty = any)\n\n");
+    
+    printf("Status: 1=ToDo, 2=InProgress, 3=Completed, 4=Cancelled, 0=Any\n");
+    f.status = getIntInput("Status", 0, 4);
+    printf("Priority: 1=Low, 2=Medium, 3=High, 4=Urgent, 0=Any\n");
+    f.priority = getIntInput("Priority", 0, 4);
+    getStringInput("Category", f.category, MAX_CATEGORY);
+    
+    int found = 0;
+    for (int i = 0; i < tm->count; i++) {
+        if (taskMatches(&f, &tm->tasks[i])) found++;
+    }
+    
+    if (found == 0) {
+        printf("\nNo tasks match this filter\n");
+        pauseScreen();
+        return;
+    }
+    
+    printf("\n%d task(s) match.\n\n", found);
+    printf("Action:\n");
+    printf("  1. Mark Complete\n  2. Cancel\n  3. Change Priority\n");
+    printf("  4. Change Category\n  5. Delete\n");
+    BulkAction action = getIntInput("Select Action", 1, 5);
+    
+    Priority priority = PRIORITY_LOW;
+    char category[MAX_CATEGORY] = "";
+    if (action == BULK_REPRIORITIZE) {
+        printf("\nPriority: 1=Low, 2=Medium, 3=High, 4=Urgent\n");
+        priority = getIntInput("New Priority", 1, 4);
+    } else if (action == BULK_RECATEGORIZE) {
+        getStringInput("New Category", category, MAX_CATEGORY);
+        if (strlen(category) == 0) {
+            printf("\n✗ No category given!\n");
+            pauseScreen();
+            return;
+        }
+    }
+    
+    printf("\nApply to %d task(s)? (y/n): ", found);
+    
+    char confirm;
+    scanf(" %c", &confirm);
+    getchar();
+    
+    if (confirm != 'y' && confirm != 'Y') {
+        printf("\n✗ Bulk update cancelled.\n");
+        pauseScreen();
+        return;
+    }
+    
+    if (!beginUpdate(tm)) {
+        pauseScreen();
+        return;
+    }
+    
+    // The filter is re-evaluated against the freshly synced tasks
+    int affected = applyBulk(tm, &f, action, priority, category);
+    if (affected == 0) {
+        unlockStore(tm);
+        printf("\nNo matching tasks needed changing\n");
+    } else if (commitUpdate(tm)) {
+        printf("\n✓ Updated %d task(s)!\n", affected);
+    }
+    pauseScreen();
+}
+
 void searchTasks(TaskManager *tm) {
     clearScreen();
     
@@ -566,6 +1403,7 @@ void sortTasks(TaskManager *tm) {
         }
     }
     
+    tm->orderChanged = 1;
     printf("\n✓ Tasks sorted successfully!\n");
     pauseScreen();
 }
@@ -616,6 +1454,85 @@ void viewStatistics(TaskManager *tm) {
     pauseScreen();
 }
 
+void exportChanges(TaskManager *tm) {
+    clearScreen();
+    
+    printf("\n═══ EXPORT CHANGES ═══\n\n");
+    printf("Current change sequence: %lu\n", tm->seq);
+    printf("Enter 0 for a full snapshot\n\n");
+    
+    unsigned long since = getSeqInput("Export changes since sequence", tm->seq);
+    
+    char filename[MAX_FILENAME];
+    getStringInput("Output file", filename, MAX_FILENAME);
+    if (strlen(filename) == 0) {
+        printf("\n✗ No file given!\n");
+        pauseScreen();
+        return;
+    }
+    
+    FILE *fp = fopen(filename, "wb");
+    if (fp == NULL) {
+        printf("\n✗ Cannot open '%s'!\n", filename);
+        pauseScreen();
+        return;
+    }
+    
+    int written = writeChanges(tm, since, fp);
+    if (fclose(fp) != 0) written = -1;
+    
+    if (written < 0) {
+        printf("\n✗ Error writing changes!\n");
+    } else {
+        printf("\n✓ Exported %d change(s) up to sequence %lu%s.\n", written, tm->seq,
+               (since == 0 || since < tm->horizon) ? " as a full snapshot" : "");
+    }
+    pauseScreen();
+}
+
+void importChanges(TaskManager *tm) {
+    clearScreen();
+    
+    printf("\n═══ IMPORT CHANGES ═══\n\n");
+    printf("Last imported source sequence: %lu\n\n", tm->sourceSeq);
+    
+    char filename[MAX_FILENAME];
+    getStringInput("Change file", filename, MAX_FILENAME);
+    
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        printf("\n✗ Cannot open '%s'!\n", filename);
+        pauseScreen();
+        return;
+    }
+    
+    if (!beginUpdate(tm)) {
+        fclose(fp);
+        pauseScreen();
+        return;
+    }
+    
+    unsigned long sourceSeq = tm->sourceSeq;
+    int applied = applyChanges(tm, fp);
+    fclose(fp);
+    
+    if (applied == -2) {
+        abortUpdate(tm);
+        printf("\n✗ Change file starts after sequence %lu, the last one imported here!\n", sourceSeq);
+        printf("  Export changes since %lu from the source instead.\n", sourceSeq);
+    } else if (applied < 0) {
+        // Discard the partial merge
+        abortUpdate(tm);
+        printf("\n✗ Invalid change file!\n");
+    } else if (applied == 0 && tm->sourceSeq == sourceSeq) {
+        abortUpdate(tm);
+        printf("\n✓ Already up to date.\n");
+    } else if (commitUpdate(tm)) {
+        printf("\n✓ Applied %d change(s), now at source sequence %lu.\n", applied, tm->sourceSeq);
+    }
+    pauseScreen();
+}
+
 void displayTask(Task *t) {
     char created[26], deadline[26];
     struct tm *tm_info;
@@ -691,6 +1608,19 @@ int getIntInput(const char *prompt, int min, int max) {
     }
 }
 
+unsigned long getSeqInput(const char *prompt, unsigned long max) {
+    unsigned long value;
+    while (1) {
+        printf("%s (0-%lu): ", prompt, max);
+        if (scanf("%lu", &value) == 1 && value <= max) {
+            getchar();
+            return value;
+        }
+        printf("✗ Invalid input! Please enter a number between 0 and %lu.\n", max);
+        while (getchar() != '\n');
+    }
+}
+
 void getStringInput(const char *prompt, char *buffer, int maxLen) {
     printf("%s: ", prompt);
     fgets(buffer, maxLen, stdin);